@@ -0,0 +1,295 @@
+
+// MIT License
+//
+// Copyright (c) 2020 degski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, rhs_, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+#include <algorithm>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+#include "one_based_array.hpp"
+
+// Element-wise arithmetic on based_array's, f.e.:
+//
+//     sax::based_array<float, 16> a, b, c, d;
+//     d = a + b * c;               // One loop, no temporaries.
+//     float s = sax::dot ( a, b ); // Or sum ( a * b ).
+//
+// The expressions are evaluated lazily, on assignment to (or construction of) a based_array. An expression refers to
+// the based_array's it was built from, so (as with any view) it should not outlive them.
+
+namespace sax {
+
+namespace detail {
+
+template<typename T>
+struct is_based_array : std::false_type {};
+template<typename ValueType, std::size_t Size, std::size_t SSEThreshold, access_mode Access>
+struct is_based_array<based_array<ValueType, Size, SSEThreshold, Access>> : std::true_type {};
+
+template<typename T>
+inline constexpr bool is_based_expression_v = std::is_base_of<based_expression_base, T>::value;
+template<typename T>
+inline constexpr bool is_based_operand_v = is_based_array<T>::value or is_based_expression_v<T>;
+template<typename T>
+inline constexpr bool is_based_scalar_v = std::is_arithmetic<T>::value;
+
+} // namespace detail
+
+// Leaves.
+
+template<typename BasedArray>
+struct based_terminal : based_expression_base {
+
+    using value_type = typename BasedArray::value_type;
+
+    explicit constexpr based_terminal ( BasedArray const & array_ ) noexcept : m_data ( array_.data ( ) ) {}
+
+    [[nodiscard]] static constexpr std::size_t size ( ) noexcept { return BasedArray::size ( ); }
+    [[nodiscard]] constexpr value_type operator[] ( std::size_t i_ ) const noexcept { return m_data[ i_ ]; }
+
+    value_type const * m_data;
+};
+
+template<typename ValueType, std::size_t Size>
+struct based_scalar : based_expression_base {
+
+    using value_type = ValueType;
+
+    explicit constexpr based_scalar ( value_type value_ ) noexcept : m_value ( value_ ) {}
+
+    [[nodiscard]] static constexpr std::size_t size ( ) noexcept { return Size; }
+    [[nodiscard]] constexpr value_type operator[] ( std::size_t ) const noexcept { return m_value; }
+
+    value_type m_value;
+};
+
+// Nodes.
+
+template<typename Op, typename Expression>
+struct based_unary : based_expression_base {
+
+    using value_type = decltype ( Op{ }( std::declval<typename Expression::value_type> ( ) ) );
+
+    explicit constexpr based_unary ( Expression const & expression_ ) noexcept : m_expression ( expression_ ) {}
+
+    [[nodiscard]] static constexpr std::size_t size ( ) noexcept { return Expression::size ( ); }
+    [[nodiscard]] constexpr value_type operator[] ( std::size_t i_ ) const noexcept { return Op{ }( m_expression[ i_ ] ); }
+
+    Expression m_expression;
+};
+
+template<typename Op, typename Lhs, typename Rhs>
+struct based_binary : based_expression_base {
+
+    static_assert ( Lhs::size ( ) == Rhs::size ( ), "based_binary: the operands are of a different size" );
+
+    using value_type =
+        decltype ( Op{ }( std::declval<typename Lhs::value_type> ( ), std::declval<typename Rhs::value_type> ( ) ) );
+
+    constexpr based_binary ( Lhs const & lhs_, Rhs const & rhs_ ) noexcept : m_lhs ( lhs_ ), m_rhs ( rhs_ ) {}
+
+    [[nodiscard]] static constexpr std::size_t size ( ) noexcept { return Lhs::size ( ); }
+    [[nodiscard]] constexpr value_type operator[] ( std::size_t i_ ) const noexcept { return Op{ }( m_lhs[ i_ ], m_rhs[ i_ ] ); }
+
+    Lhs m_lhs;
+    Rhs m_rhs;
+};
+
+namespace detail {
+
+// Based_array's are referred to, expressions are copied (they're small, and may be temporaries).
+template<typename Operand>
+[[nodiscard]] constexpr auto as_expression ( Operand const & operand_ ) noexcept {
+    if constexpr ( is_based_array<Operand>::value )
+        return based_terminal<Operand> ( operand_ );
+    else
+        return operand_;
+}
+
+template<typename Op, typename Lhs, typename Rhs>
+[[nodiscard]] constexpr auto make_binary ( Lhs const & lhs_, Rhs const & rhs_ ) noexcept {
+    if constexpr ( is_based_scalar_v<Lhs> ) {
+        using rhs_type = decltype ( as_expression ( rhs_ ) );
+        using lhs_type = based_scalar<Lhs, rhs_type::size ( )>;
+        return based_binary<Op, lhs_type, rhs_type> ( lhs_type ( lhs_ ), as_expression ( rhs_ ) );
+    }
+    else if constexpr ( is_based_scalar_v<Rhs> ) {
+        using lhs_type = decltype ( as_expression ( lhs_ ) );
+        using rhs_type = based_scalar<Rhs, lhs_type::size ( )>;
+        return based_binary<Op, lhs_type, rhs_type> ( as_expression ( lhs_ ), rhs_type ( rhs_ ) );
+    }
+    else {
+        return based_binary<Op, decltype ( as_expression ( lhs_ ) ), decltype ( as_expression ( rhs_ ) )> (
+            as_expression ( lhs_ ), as_expression ( rhs_ ) );
+    }
+}
+
+template<typename Lhs, typename Rhs>
+inline constexpr bool is_based_binary_v = ( is_based_operand_v<Lhs> and is_based_operand_v<Rhs> ) or
+                                          ( is_based_operand_v<Lhs> and is_based_scalar_v<Rhs> ) or
+                                          ( is_based_scalar_v<Lhs> and is_based_operand_v<Rhs> );
+
+// Reduction with independent accumulators (one vector register worth), the loop-carried dependency of a single
+// accumulator would otherwise prevent vectorization of floating point reductions. Of the n_ (> 0) elements
+// element_ ( 0 ) through element_ ( n_ - 1 ), Lanes accumulators, fewer elements are reduced in order.
+template<std::size_t Lanes, typename Element, typename Op>
+[[nodiscard]] constexpr auto reduce_n ( Element element_, std::size_t n_, Op op_ ) noexcept {
+    using value_type = std::remove_cvref_t<decltype ( element_ ( std::size_t{ } ) )>;
+    assert ( n_ > 0ull );
+    if ( n_ < Lanes ) {
+        value_type acc = element_ ( 0ull );
+        for ( std::size_t i = 1ull; i < n_; ++i )
+            acc = op_ ( acc, element_ ( i ) );
+        return acc;
+    }
+    value_type acc[ Lanes ];
+    for ( std::size_t l = 0ull; l < Lanes; ++l )
+        acc[ l ] = element_ ( l );
+    std::size_t i = Lanes;
+    for ( ; i + Lanes <= n_; i += Lanes )
+        for ( std::size_t l = 0ull; l < Lanes; ++l )
+            acc[ l ] = op_ ( acc[ l ], element_ ( i + l ) );
+    for ( std::size_t l = 0ull; i < n_; ++i, ++l )
+        acc[ l ] = op_ ( acc[ l ], element_ ( i ) );
+    for ( std::size_t width = Lanes; width > 1ull; ) {
+        std::size_t const half = width / 2ull;
+        for ( std::size_t l = 0ull; l < half; ++l )
+            acc[ l ] = op_ ( acc[ l ], acc[ width - half + l ] );
+        width -= half;
+    }
+    return acc[ 0 ];
+}
+
+// The accumulators of a vector register (of 32 bytes) of ValueType's.
+template<typename ValueType>
+inline constexpr std::size_t reduce_lanes = std::max<std::size_t> ( 1ull, 32ull / sizeof ( ValueType ) );
+
+template<typename Expression, typename Op>
+[[nodiscard]] constexpr typename Expression::value_type reduce ( Expression const & expression_, Op op_ ) noexcept {
+    constexpr std::size_t size = Expression::size ( );
+    static_assert ( size > 0ull, "reduce: the expression is empty" );
+    return reduce_n<std::min ( size, reduce_lanes<typename Expression::value_type> )> (
+        [ & ] ( std::size_t i_ ) { return expression_[ i_ ]; }, size, op_ );
+}
+
+struct min_op {
+    template<typename T>
+    [[nodiscard]] constexpr T operator( ) ( T const & lhs_, T const & rhs_ ) const noexcept {
+        return rhs_ < lhs_ ? rhs_ : lhs_;
+    }
+};
+struct max_op {
+    template<typename T>
+    [[nodiscard]] constexpr T operator( ) ( T const & lhs_, T const & rhs_ ) const noexcept {
+        return lhs_ < rhs_ ? rhs_ : lhs_;
+    }
+};
+
+} // namespace detail
+
+// Arithmetic.
+
+template<typename Lhs, typename Rhs>
+requires( detail::is_based_binary_v<Lhs, Rhs> ) //
+    [[nodiscard]] constexpr auto operator+ ( Lhs const & lhs_, Rhs const & rhs_ ) noexcept {
+    return detail::make_binary<std::plus<>> ( lhs_, rhs_ );
+}
+template<typename Lhs, typename Rhs>
+requires( detail::is_based_binary_v<Lhs, Rhs> ) //
+    [[nodiscard]] constexpr auto operator- ( Lhs const & lhs_, Rhs const & rhs_ ) noexcept {
+    return detail::make_binary<std::minus<>> ( lhs_, rhs_ );
+}
+template<typename Lhs, typename Rhs>
+requires( detail::is_based_binary_v<Lhs, Rhs> ) //
+    [[nodiscard]] constexpr auto operator* ( Lhs const & lhs_, Rhs const & rhs_ ) noexcept {
+    return detail::make_binary<std::multiplies<>> ( lhs_, rhs_ );
+}
+template<typename Lhs, typename Rhs>
+requires( detail::is_based_binary_v<Lhs, Rhs> ) //
+    [[nodiscard]] constexpr auto operator/ ( Lhs const & lhs_, Rhs const & rhs_ ) noexcept {
+    return detail::make_binary<std::divides<>> ( lhs_, rhs_ );
+}
+
+template<typename Operand>
+requires( detail::is_based_operand_v<Operand> ) //
+    [[nodiscard]] constexpr auto operator- ( Operand const & operand_ ) noexcept {
+    return based_unary<std::negate<>, decltype ( detail::as_expression ( operand_ ) )> ( detail::as_expression ( operand_ ) );
+}
+
+// Compound assignment.
+
+template<typename ValueType, std::size_t Size, std::size_t SSEThreshold, access_mode Access, typename Rhs>
+requires( detail::is_based_operand_v<Rhs> or detail::is_based_scalar_v<Rhs> ) //
+    [[maybe_unused]] constexpr based_array<ValueType, Size, SSEThreshold, Access> &
+    operator+= ( based_array<ValueType, Size, SSEThreshold, Access> & lhs_, Rhs const & rhs_ ) noexcept {
+    return lhs_ = lhs_ + rhs_;
+}
+template<typename ValueType, std::size_t Size, std::size_t SSEThreshold, access_mode Access, typename Rhs>
+requires( detail::is_based_operand_v<Rhs> or detail::is_based_scalar_v<Rhs> ) //
+    [[maybe_unused]] constexpr based_array<ValueType, Size, SSEThreshold, Access> &
+    operator-= ( based_array<ValueType, Size, SSEThreshold, Access> & lhs_, Rhs const & rhs_ ) noexcept {
+    return lhs_ = lhs_ - rhs_;
+}
+template<typename ValueType, std::size_t Size, std::size_t SSEThreshold, access_mode Access, typename Rhs>
+requires( detail::is_based_operand_v<Rhs> or detail::is_based_scalar_v<Rhs> ) //
+    [[maybe_unused]] constexpr based_array<ValueType, Size, SSEThreshold, Access> &
+    operator*= ( based_array<ValueType, Size, SSEThreshold, Access> & lhs_, Rhs const & rhs_ ) noexcept {
+    return lhs_ = lhs_ * rhs_;
+}
+template<typename ValueType, std::size_t Size, std::size_t SSEThreshold, access_mode Access, typename Rhs>
+requires( detail::is_based_operand_v<Rhs> or detail::is_based_scalar_v<Rhs> ) //
+    [[maybe_unused]] constexpr based_array<ValueType, Size, SSEThreshold, Access> &
+    operator/= ( based_array<ValueType, Size, SSEThreshold, Access> & lhs_, Rhs const & rhs_ ) noexcept {
+    return lhs_ = lhs_ / rhs_;
+}
+
+// Reductions.
+
+template<typename Operand>
+requires( detail::is_based_operand_v<Operand> ) //
+    [[nodiscard]] constexpr auto sum ( Operand const & operand_ ) noexcept {
+    return detail::reduce ( detail::as_expression ( operand_ ), std::plus<>{ } );
+}
+template<typename Lhs, typename Rhs>
+requires( detail::is_based_operand_v<Lhs> and detail::is_based_operand_v<Rhs> ) //
+    [[nodiscard]] constexpr auto dot ( Lhs const & lhs_, Rhs const & rhs_ ) noexcept {
+    return detail::reduce ( detail::make_binary<std::multiplies<>> ( lhs_, rhs_ ), std::plus<>{ } );
+}
+template<typename Operand>
+requires( detail::is_based_operand_v<Operand> ) //
+    [[nodiscard]] constexpr auto min ( Operand const & operand_ ) noexcept {
+    return detail::reduce ( detail::as_expression ( operand_ ), detail::min_op{ } );
+}
+template<typename Operand>
+requires( detail::is_based_operand_v<Operand> ) //
+    [[nodiscard]] constexpr auto max ( Operand const & operand_ ) noexcept {
+    return detail::reduce ( detail::as_expression ( operand_ ), detail::max_op{ } );
+}
+
+} // namespace sax
@@ -0,0 +1,236 @@
+
+// MIT License
+//
+// Copyright (c) 2020 degski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, rhs_, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cerrno>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <charconv>
+#include <span>
+#include <type_traits>
+
+#if defined( _WIN32 )
+#    include <io.h>
+#else
+#    include <sys/uio.h>
+#    include <unistd.h>
+#endif
+
+namespace sax {
+
+// Binary (de-)serialization of contiguous storage, a fixed header followed by the raw elements, written or read
+// with one (vectored) system call, or one memcpy per part in the case of a buffer. The format is native, i.e. neither
+// endianness nor padding are converted, it's meant for snapshots read back on the same kind of machine.
+
+enum class io_kind : std::uint16_t { based_array = 1, beap = 2 };
+
+struct io_header {
+    static constexpr std::uint32_t magic_value   = 0x42'58'41'53; // "SAXB" (little-endian).
+    static constexpr std::uint16_t version_value = 1;
+
+    std::uint32_t magic      = magic_value;
+    std::uint16_t version    = version_value;
+    io_kind kind             = io_kind::based_array;
+    std::uint32_t value_size = 0; // sizeof ( value_type ).
+    std::uint32_t reserved   = 0;
+    std::uint64_t size       = 0; // Number of elements.
+
+    [[nodiscard]] constexpr bool valid ( io_kind kind_, std::size_t value_size_ ) const noexcept {
+        return magic == magic_value and version == version_value and kind == kind_ and value_size == value_size_;
+    }
+};
+
+static_assert ( sizeof ( io_header ) == 24ull, "io_header: unexpected padding" );
+
+namespace detail {
+
+struct io_vec {
+    void * base;
+    std::size_t size;
+};
+
+// Write all, resp. read all, of the parts, retrying on partial transfers and on EINTR. Returns false on error or
+// (when reading) on a premature end of file.
+
+inline bool write_all ( int fd_, io_vec * parts_, int n_ ) noexcept {
+#if defined( _WIN32 )
+    for ( ; n_; ++parts_, --n_ ) {
+        char const * p = static_cast<char const *> ( parts_->base );
+        for ( std::size_t s = parts_->size; s; ) {
+            int const w = ::_write ( fd_, p, static_cast<unsigned int> ( s < INT_MAX ? s : INT_MAX ) );
+            if ( w < 0 )
+                return false;
+            p += w;
+            s -= static_cast<std::size_t> ( w );
+        }
+    }
+    return true;
+#else
+    ::iovec iov[ 4 ];
+    for ( int i = 0; i < n_; ++i )
+        iov[ i ] = { parts_[ i ].base, parts_[ i ].size };
+    for ( ::iovec * v = iov; n_; ) {
+        ::ssize_t w = ::writev ( fd_, v, n_ );
+        if ( w < 0 ) {
+            if ( errno == EINTR )
+                continue;
+            return false;
+        }
+        for ( ; n_ and static_cast<std::size_t> ( w ) >= v->iov_len; ++v, --n_ )
+            w -= static_cast<::ssize_t> ( v->iov_len );
+        if ( n_ ) {
+            v->iov_base = static_cast<char *> ( v->iov_base ) + w;
+            v->iov_len -= static_cast<std::size_t> ( w );
+        }
+    }
+    return true;
+#endif
+}
+
+inline bool read_all ( int fd_, io_vec * parts_, int n_ ) noexcept {
+#if defined( _WIN32 )
+    for ( ; n_; ++parts_, --n_ ) {
+        char * p = static_cast<char *> ( parts_->base );
+        for ( std::size_t s = parts_->size; s; ) {
+            int const r = ::_read ( fd_, p, static_cast<unsigned int> ( s < INT_MAX ? s : INT_MAX ) );
+            if ( r <= 0 )
+                return false;
+            p += r;
+            s -= static_cast<std::size_t> ( r );
+        }
+    }
+    return true;
+#else
+    ::iovec iov[ 4 ];
+    for ( int i = 0; i < n_; ++i )
+        iov[ i ] = { parts_[ i ].base, parts_[ i ].size };
+    for ( ::iovec * v = iov; n_; ) {
+        ::ssize_t r = ::readv ( fd_, v, n_ );
+        if ( r < 0 ) {
+            if ( errno == EINTR )
+                continue;
+            return false;
+        }
+        if ( r == 0 )
+            return false;
+        for ( ; n_ and static_cast<std::size_t> ( r ) >= v->iov_len; ++v, --n_ )
+            r -= static_cast<::ssize_t> ( v->iov_len );
+        if ( n_ ) {
+            v->iov_base = static_cast<char *> ( v->iov_base ) + r;
+            v->iov_len -= static_cast<std::size_t> ( r );
+        }
+    }
+    return true;
+#endif
+}
+
+template<typename ValueType>
+[[nodiscard]] bool write_binary ( int fd_, io_kind kind_, ValueType const * data_, std::size_t size_ ) noexcept {
+    static_assert ( std::is_trivially_copyable<ValueType>::value, "write_to: the value_type should be trivially copyable" );
+    io_header header{ };
+    header.kind       = kind_;
+    header.value_size = sizeof ( ValueType );
+    header.size       = size_;
+    io_vec parts[ 2 ] = { { &header, sizeof ( io_header ) }, { const_cast<ValueType *> ( data_ ), size_ * sizeof ( ValueType ) } };
+    return write_all ( fd_, parts, 2 );
+}
+
+// Returns the number of bytes written, 0 if the buffer is too small.
+template<typename ValueType>
+[[nodiscard]] std::size_t write_binary ( std::span<std::byte> buffer_, io_kind kind_, ValueType const * data_,
+                                         std::size_t size_ ) noexcept {
+    static_assert ( std::is_trivially_copyable<ValueType>::value, "write_to: the value_type should be trivially copyable" );
+    // Compared in elements, size_ * sizeof ( ValueType ) could overflow.
+    if ( buffer_.size ( ) < sizeof ( io_header ) or ( buffer_.size ( ) - sizeof ( io_header ) ) / sizeof ( ValueType ) < size_ )
+        return 0ull;
+    std::size_t const bytes = sizeof ( io_header ) + size_ * sizeof ( ValueType );
+    io_header header{ };
+    header.kind       = kind_;
+    header.value_size = sizeof ( ValueType );
+    header.size       = size_;
+    std::memcpy ( buffer_.data ( ), &header, sizeof ( io_header ) );
+    std::memcpy ( buffer_.data ( ) + sizeof ( io_header ), data_, size_ * sizeof ( ValueType ) );
+    return bytes;
+}
+
+// Reads and validates the header, returns the number of elements that follow, or -1 on failure.
+template<typename ValueType>
+[[nodiscard]] std::int64_t read_header ( int fd_, io_kind kind_ ) noexcept {
+    io_header header;
+    io_vec part = { &header, sizeof ( io_header ) };
+    if ( not read_all ( fd_, &part, 1 ) or not header.valid ( kind_, sizeof ( ValueType ) ) )
+        return -1;
+    return static_cast<std::int64_t> ( header.size );
+}
+template<typename ValueType>
+[[nodiscard]] std::int64_t read_header ( std::span<std::byte const> buffer_, io_kind kind_ ) noexcept {
+    io_header header;
+    if ( buffer_.size ( ) < sizeof ( io_header ) )
+        return -1;
+    std::memcpy ( &header, buffer_.data ( ), sizeof ( io_header ) );
+    if ( not header.valid ( kind_, sizeof ( ValueType ) ) or
+         ( buffer_.size ( ) - sizeof ( io_header ) ) / sizeof ( ValueType ) < header.size )
+        return -1;
+    return static_cast<std::int64_t> ( header.size );
+}
+
+// Header and elements of a known number of elements in one go, the contents of data_ are unspecified on failure.
+template<typename ValueType>
+[[nodiscard]] bool read_binary ( int fd_, io_kind kind_, ValueType * data_, std::size_t size_ ) noexcept {
+    static_assert ( std::is_trivially_copyable<ValueType>::value, "read_from: the value_type should be trivially copyable" );
+    io_header header;
+    io_vec parts[ 2 ] = { { &header, sizeof ( io_header ) }, { data_, size_ * sizeof ( ValueType ) } };
+    return read_all ( fd_, parts, 2 ) and header.valid ( kind_, sizeof ( ValueType ) ) and header.size == size_;
+}
+
+// Text output, formatted with std::to_chars into a local buffer, handed to the stream in large chunks. Types that
+// std::to_chars does not know are formatted with operator<<.
+template<typename Stream, typename ValueType>
+Stream & write_text ( Stream & out_, ValueType const * data_, std::size_t size_ ) {
+    if constexpr ( std::is_arithmetic<ValueType>::value and not std::is_same<ValueType, bool>::value ) {
+        constexpr std::size_t capacity = 4'096ull, max_chars = 64ull;
+        char buffer[ capacity ];
+        char * p = buffer;
+        for ( ValueType const * e = data_, * end = data_ + size_; e != end; ++e ) {
+            if ( ( buffer + capacity - p ) < static_cast<std::ptrdiff_t> ( max_chars ) ) {
+                out_.write ( buffer, p - buffer );
+                p = buffer;
+            }
+            p    = std::to_chars ( p, buffer + capacity, *e ).ptr;
+            *p++ = ' ';
+        }
+        out_.write ( buffer, p - buffer );
+    }
+    else {
+        for ( ValueType const * e = data_, * end = data_ + size_; e != end; ++e )
+            out_ << *e << ' ';
+    }
+    return out_;
+}
+
+} // namespace detail
+} // namespace sax
@@ -0,0 +1,186 @@
+
+// MIT License
+//
+// Copyright (c) 2020 degski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, rhs_, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+#include "one_based_array.hpp"
+
+// Sorting and selection of based_array's, f.e.:
+//
+//     sax::based_array<float, 16> a;
+//     sax::sort ( a );               // Sorting network, 63 compare-exchanges, no branches (for arithmetic types).
+//     sax::partial_sort<4> ( a );    // The 4 smallest, in order, in front.
+//     float m = sax::median ( a );   // The network pruned to what decides the middle element.
+//
+// Up to 64 elements, these are Batcher's odd-even merge sort networks, generated at compile time, fully unrolled. For
+// partial_sort, nth_element and median, the network is pruned to the compare-exchanges the requested positions depend
+// on. Above 64 elements, these fall back to the std algorithms.
+
+namespace sax {
+
+namespace detail {
+
+inline constexpr std::size_t network_max_size = 64u;
+
+struct comparator {
+    std::uint8_t lo, hi;
+};
+
+// Batcher's odd-even merge sort, for the power of 2 not less than Size, without the comparators that touch an index
+// beyond Size (padding with values greater than any, those are no-ops). Only the comparators that (transitively) feed
+// into the positions in Needed (a bit mask) are kept, the network is walked backwards, a comparator is kept if either
+// of its positions is needed, and then both are.
+template<std::size_t Size, std::uint64_t Needed, bool Count>
+constexpr auto odd_even_merge_network ( ) noexcept {
+    constexpr std::size_t capacity = 1'024u; // 543 for Size 64, the largest.
+    std::array<comparator, capacity> all = { };
+    std::size_t n                        = 0u, padded = 1u;
+    while ( padded < Size )
+        padded <<= 1;
+    for ( std::size_t p = 1u; p < padded; p <<= 1 )
+        for ( std::size_t k = p; k >= 1u; k >>= 1 )
+            for ( std::size_t j = k % p; j + k < padded; j += 2u * k )
+                for ( std::size_t i = 0u; i < k and i + j + k < padded; ++i )
+                    if ( ( i + j ) / ( 2u * p ) == ( i + j + k ) / ( 2u * p ) and i + j + k < Size )
+                        all[ n++ ] = { static_cast<std::uint8_t> ( i + j ), static_cast<std::uint8_t> ( i + j + k ) };
+    std::array<bool, capacity> keep = { };
+    std::uint64_t needed            = Needed;
+    std::size_t kept                = 0u;
+    for ( std::size_t c = n; c-- > 0u; ) {
+        std::uint64_t const bits = ( std::uint64_t{ 1 } << all[ c ].lo ) | ( std::uint64_t{ 1 } << all[ c ].hi );
+        if ( needed & bits ) {
+            keep[ c ] = true;
+            needed |= bits;
+            ++kept;
+        }
+    }
+    if constexpr ( Count ) {
+        return kept;
+    }
+    else {
+        std::array<comparator, odd_even_merge_network<Size, Needed, true> ( )> network = { };
+        for ( std::size_t c = 0u, i = 0u; c < n; ++c )
+            if ( keep[ c ] )
+                network[ i++ ] = all[ c ];
+        return network;
+    }
+}
+
+template<std::size_t Size, std::uint64_t Needed>
+inline constexpr auto network_v = odd_even_merge_network<Size, Needed, false> ( );
+
+// Positions [ b, e ) as a bit mask.
+[[nodiscard]] constexpr std::uint64_t position_mask ( std::size_t b_, std::size_t e_ ) noexcept {
+    std::uint64_t m = 0u;
+    for ( std::size_t i = b_; i < e_; ++i )
+        m |= std::uint64_t{ 1 } << i;
+    return m;
+}
+
+// Compare-exchange, min and max for arithmetic types with std::less (minss/maxss, pminsd, or cmov), a conditional
+// swap otherwise.
+template<typename ValueType, typename Compare>
+inline void compare_exchange ( ValueType & l_, ValueType & r_, Compare compare_ ) noexcept {
+    if constexpr ( std::is_arithmetic<ValueType>::value and
+                   ( std::is_same<Compare, std::less<>>::value or std::is_same<Compare, std::less<ValueType>>::value ) ) {
+        ValueType const l = l_, r = r_;
+        l_                = r < l ? r : l;
+        r_                = r < l ? l : r;
+    }
+    else {
+        if ( compare_ ( r_, l_ ) )
+            std::swap ( l_, r_ );
+    }
+}
+
+template<auto const & Network, typename ValueType, typename Compare>
+inline void apply_network ( ValueType * data_, Compare compare_ ) noexcept {
+    [ & ]<std::size_t... I> ( std::index_sequence<I...> ) {
+        ( compare_exchange ( data_[ Network[ I ].lo ], data_[ Network[ I ].hi ], compare_ ), ... );
+    }
+    ( std::make_index_sequence<Network.size ( )> ( ) );
+}
+
+} // namespace detail
+
+template<typename ValueType, std::size_t Size, std::size_t SSEThreshold, access_mode Access, typename Compare = std::less<ValueType>>
+void sort ( based_array<ValueType, Size, SSEThreshold, Access> & a_, Compare compare_ = Compare ( ) ) {
+    if constexpr ( Size <= detail::network_max_size )
+        detail::apply_network<detail::network_v<Size, detail::position_mask ( 0u, Size )>> ( a_.data ( ), compare_ );
+    else
+        std::sort ( a_.data ( ), a_.data ( ) + Size, compare_ );
+}
+
+// The K smallest in order in front, the remainder in unspecified order.
+template<std::size_t K, typename ValueType, std::size_t Size, std::size_t SSEThreshold, access_mode Access,
+         typename Compare = std::less<ValueType>>
+void partial_sort ( based_array<ValueType, Size, SSEThreshold, Access> & a_, Compare compare_ = Compare ( ) ) {
+    static_assert ( K <= Size, "partial_sort: K should not exceed the Size" );
+    if constexpr ( Size <= detail::network_max_size )
+        detail::apply_network<detail::network_v<Size, detail::position_mask ( 0u, K )>> ( a_.data ( ), compare_ );
+    else
+        std::partial_sort ( a_.data ( ), a_.data ( ) + K, a_.data ( ) + Size, compare_ );
+}
+
+// As std::nth_element, the element at N is the one that would be there if sorted, the ones before it are not greater,
+// the ones after it not less. The network is pruned for position N, and followed by a partition around that element.
+template<std::size_t N, typename ValueType, std::size_t Size, std::size_t SSEThreshold, access_mode Access,
+         typename Compare = std::less<ValueType>>
+void nth_element ( based_array<ValueType, Size, SSEThreshold, Access> & a_, Compare compare_ = Compare ( ) ) {
+    static_assert ( N < Size, "nth_element: N should be less than the Size" );
+    ValueType * const b = a_.data ( ), * const e = b + Size;
+    if constexpr ( Size <= detail::network_max_size ) {
+        detail::apply_network<detail::network_v<Size, detail::position_mask ( N, N + 1u )>> ( b, compare_ );
+        ValueType const nth = b[ N ];
+        ValueType * const m = std::partition ( b, e, [ & ] ( ValueType const & v_ ) { return compare_ ( v_, nth ); } );
+        std::partition ( m, e, [ & ] ( ValueType const & v_ ) { return not compare_ ( nth, v_ ); } );
+    }
+    else {
+        std::nth_element ( b, b + N, e, compare_ );
+    }
+}
+
+// The element at Size / 2 in sorted order (for an even Size, the greater of the two in the middle), a_ is not
+// modified.
+template<typename ValueType, std::size_t Size, std::size_t SSEThreshold, access_mode Access, typename Compare = std::less<ValueType>>
+[[nodiscard]] ValueType median ( based_array<ValueType, Size, SSEThreshold, Access> const & a_, Compare compare_ = Compare ( ) ) {
+    static_assert ( Size > 0u, "median: the based_array should not be empty" );
+    std::array<ValueType, Size> copy;
+    std::copy ( a_.data ( ), a_.data ( ) + Size, copy.data ( ) );
+    if constexpr ( Size <= detail::network_max_size )
+        detail::apply_network<detail::network_v<Size, detail::position_mask ( Size / 2u, Size / 2u + 1u )>> ( copy.data ( ), compare_ );
+    else
+        std::nth_element ( copy.begin ( ), copy.begin ( ) + Size / 2u, copy.end ( ), compare_ );
+    return copy[ Size / 2u ];
+}
+
+} // namespace sax
@@ -0,0 +1,301 @@
+
+// MIT License
+//
+// Copyright (c) 2020 degski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, rhs_, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+
+#include <array>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#if __has_include( <mdspan>)
+#    include <mdspan>
+#endif
+
+#include "one_based_array.hpp"
+
+namespace sax {
+
+// Compile-time extents and (per dimension) index bases of a md_based_array, f.e. md_extents<3, 4> and md_bases<1, 1>
+// describe a 3 x 4 matrix, indexed Fortran-like from ( 1, 1 ) through ( 3, 4 ).
+
+template<std::size_t... Extents>
+struct md_extents {
+    static_assert ( sizeof...( Extents ) > 0ull, "md_extents: at least one dimension is required" );
+    [[nodiscard]] static constexpr std::size_t rank ( ) noexcept { return sizeof...( Extents ); }
+    [[nodiscard]] static constexpr std::size_t size ( ) noexcept { return ( Extents * ... ); }
+    static constexpr std::array<std::ptrdiff_t, sizeof...( Extents )> values = { static_cast<std::ptrdiff_t> ( Extents )... };
+};
+
+template<std::ptrdiff_t... Bases>
+struct md_bases {
+    [[nodiscard]] static constexpr std::size_t rank ( ) noexcept { return sizeof...( Bases ); }
+    static constexpr std::array<std::ptrdiff_t, sizeof...( Bases )> values = { Bases... };
+};
+
+// Storage order, the names (and meaning) follow std::mdspan.
+
+struct md_layout_right {}; // Row-major, C/C++.
+struct md_layout_left {};  // Column-major, Fortran/Julia.
+
+namespace detail {
+
+// All of the below is evaluated at compile time, the index computation in the access functions reduces to a dot
+// product of the indices with constant strides, minus one constant offset (the bases folded in).
+
+template<typename Extents, typename Layout>
+[[nodiscard]] constexpr std::array<std::ptrdiff_t, Extents::rank ( )> md_strides ( ) noexcept {
+    std::array<std::ptrdiff_t, Extents::rank ( )> strides = { };
+    std::ptrdiff_t stride                                  = 1;
+    if constexpr ( std::is_same<Layout, md_layout_right>::value ) {
+        for ( std::size_t r = Extents::rank ( ); r-- > 0ull; stride *= Extents::values[ r ] )
+            strides[ r ] = stride;
+    }
+    else {
+        for ( std::size_t r = 0ull; r < Extents::rank ( ); stride *= Extents::values[ r++ ] )
+            strides[ r ] = stride;
+    }
+    return strides;
+}
+
+template<typename Extents, typename Bases, typename Layout>
+[[nodiscard]] constexpr std::ptrdiff_t md_origin ( ) noexcept {
+    constexpr std::array<std::ptrdiff_t, Extents::rank ( )> strides = md_strides<Extents, Layout> ( );
+    std::ptrdiff_t origin                                         = 0;
+    for ( std::size_t r = 0ull; r < Extents::rank ( ); ++r )
+        origin += Bases::values[ r ] * strides[ r ];
+    return origin;
+}
+
+template<typename Extents, typename Bases, typename Layout>
+struct md_mapping {
+
+    static_assert ( Extents::rank ( ) == Bases::rank ( ), "md_mapping: the extents and the bases should be of equal rank" );
+    static_assert ( std::is_same<Layout, md_layout_right>::value or std::is_same<Layout, md_layout_left>::value,
+                    "md_mapping: unsupported layout" );
+
+    static constexpr std::array<std::ptrdiff_t, Extents::rank ( )> strides = md_strides<Extents, Layout> ( );
+    static constexpr std::ptrdiff_t origin                                 = md_origin<Extents, Bases, Layout> ( );
+
+    template<typename... Indices>
+    [[nodiscard]] static constexpr std::ptrdiff_t offset ( Indices const... i_ ) noexcept {
+        return offset_impl ( std::make_index_sequence<Extents::rank ( )> ( ), static_cast<std::ptrdiff_t> ( i_ )... );
+    }
+
+    template<typename... Indices>
+    [[nodiscard]] static constexpr bool in_bounds ( Indices const... i_ ) noexcept {
+        return in_bounds_impl ( std::make_index_sequence<Extents::rank ( )> ( ), static_cast<std::ptrdiff_t> ( i_ )... );
+    }
+
+    private:
+    template<std::size_t... R, typename... Indices>
+    [[nodiscard]] static constexpr std::ptrdiff_t offset_impl ( std::index_sequence<R...>, Indices const... i_ ) noexcept {
+        return ( ( i_ * strides[ R ] ) + ... ) - origin;
+    }
+    template<std::size_t... R, typename... Indices>
+    [[nodiscard]] static constexpr bool in_bounds_impl ( std::index_sequence<R...>, Indices const... i_ ) noexcept {
+        return ( ( static_cast<std::size_t> ( i_ - Bases::values[ R ] ) < static_cast<std::size_t> ( Extents::values[ R ] ) ) and
+                 ... );
+    }
+};
+
+} // namespace detail
+
+// Non-owning, mdspan-like, view over a multi-dimensional based array (the view does not own the memory).
+
+template<typename ValueType, typename Extents, typename Bases, typename Layout = md_layout_right>
+struct md_based_view {
+
+    private:
+    using mapping_type = detail::md_mapping<Extents, Bases, Layout>;
+
+    public:
+    using value_type      = std::remove_cv_t<ValueType>;
+    using element_type    = ValueType;
+    using size_type       = std::size_t;
+    using index_type      = std::ptrdiff_t;
+    using difference_type = std::ptrdiff_t;
+    using reference       = element_type &;
+    using pointer         = element_type *;
+    using extents_type    = Extents;
+    using bases_type      = Bases;
+    using layout_type     = Layout;
+
+    constexpr md_based_view ( ) noexcept                         = default;
+    constexpr md_based_view ( md_based_view const & ) noexcept = default;
+    constexpr md_based_view ( md_based_view && ) noexcept      = default;
+
+    explicit constexpr md_based_view ( pointer pointer_ ) noexcept : m_data ( pointer_ ) {}
+
+    [[maybe_unused]] constexpr md_based_view & operator= ( md_based_view const & ) noexcept = default;
+    [[maybe_unused]] constexpr md_based_view & operator= ( md_based_view && ) noexcept = default;
+
+    // Access.
+
+    template<typename... Indices>
+    requires( sizeof...( Indices ) == Extents::rank ( ) and ( std::is_integral<Indices>::value and ... ) ) //
+        [[nodiscard]] constexpr reference operator( ) ( Indices const... i_ ) const noexcept {
+        assert ( mapping_type::in_bounds ( i_... ) );
+        return m_data[ mapping_type::offset ( i_... ) ];
+    }
+
+    // Sizes and strides.
+
+    [[nodiscard]] static constexpr size_type rank ( ) noexcept { return Extents::rank ( ); }
+    [[nodiscard]] static constexpr size_type rank_dynamic ( ) noexcept { return 0ull; }
+    [[nodiscard]] static constexpr size_type static_extent ( size_type r_ ) noexcept { return Extents::values[ r_ ]; }
+    [[nodiscard]] static constexpr index_type extent ( size_type r_ ) noexcept { return Extents::values[ r_ ]; }
+    [[nodiscard]] static constexpr index_type base ( size_type r_ ) noexcept { return Bases::values[ r_ ]; }
+    [[nodiscard]] static constexpr index_type stride ( size_type r_ ) noexcept { return mapping_type::strides[ r_ ]; }
+    [[nodiscard]] static constexpr size_type size ( ) noexcept { return Extents::size ( ); }
+
+    [[nodiscard]] static constexpr bool is_unique ( ) noexcept { return true; }
+    [[nodiscard]] static constexpr bool is_exhaustive ( ) noexcept { return true; }
+    [[nodiscard]] static constexpr bool is_strided ( ) noexcept { return true; }
+
+    [[nodiscard]] constexpr pointer data_handle ( ) const noexcept { return m_data; }
+
+#if defined( __cpp_lib_mdspan )
+    // The zero-based std::mdspan over the same memory.
+
+    [[nodiscard]] constexpr auto to_mdspan ( ) const noexcept {
+        return to_mdspan_impl ( std::make_index_sequence<Extents::rank ( )> ( ) );
+    }
+
+    private:
+    template<std::size_t... R>
+    [[nodiscard]] constexpr auto to_mdspan_impl ( std::index_sequence<R...> ) const noexcept {
+        using std_layout_type =
+            typename std::conditional<std::is_same<Layout, md_layout_right>::value, std::layout_right, std::layout_left>::type;
+        return std::mdspan<element_type, std::extents<index_type, Extents::values[ R ]...>, std_layout_type> ( m_data );
+    }
+
+    public:
+#endif
+
+    pointer m_data = nullptr;
+};
+
+// Multi-dimensional based array, stored in a (flat) based_array.
+
+template<typename ValueType, typename Extents, typename Bases, typename Layout = md_layout_right>
+struct md_based_array {
+
+    private:
+    using data_type    = based_array<ValueType, Extents::size ( )>;
+    using mapping_type = detail::md_mapping<Extents, Bases, Layout>;
+
+    public:
+    using value_type             = typename data_type::value_type;
+    using size_type              = typename data_type::size_type;
+    using index_type             = std::ptrdiff_t;
+    using difference_type        = typename data_type::difference_type;
+    using reference              = typename data_type::reference;
+    using const_reference        = typename data_type::const_reference;
+    using pointer                = typename data_type::pointer;
+    using const_pointer          = typename data_type::const_pointer;
+    using iterator               = typename data_type::iterator;
+    using const_iterator         = typename data_type::const_iterator;
+    using reverse_iterator       = typename data_type::reverse_iterator;
+    using const_reverse_iterator = typename data_type::const_reverse_iterator;
+    using extents_type           = Extents;
+    using bases_type             = Bases;
+    using layout_type            = Layout;
+
+    using view_type       = md_based_view<value_type, Extents, Bases, Layout>;
+    using const_view_type = md_based_view<value_type const, Extents, Bases, Layout>;
+
+    // data ( ), allows interaction with STL.
+
+    [[nodiscard]] constexpr const_pointer data ( ) const noexcept { return m_data.data ( ); }
+    [[nodiscard]] constexpr pointer data ( ) noexcept { return m_data.data ( ); }
+
+    // Iterators, in storage order.
+
+    [[nodiscard]] iterator begin ( ) noexcept { return m_data.begin ( ); }
+    [[nodiscard]] const_iterator cbegin ( ) const noexcept { return m_data.cbegin ( ); }
+
+    [[nodiscard]] iterator end ( ) noexcept { return m_data.end ( ); }
+    [[nodiscard]] const_iterator cend ( ) const noexcept { return m_data.cend ( ); }
+
+    // Access.
+
+    template<typename... Indices>
+    requires( sizeof...( Indices ) == Extents::rank ( ) and ( std::is_integral<Indices>::value and ... ) ) //
+        [[nodiscard]] constexpr const_reference operator( ) ( Indices const... i_ ) const noexcept {
+        assert ( mapping_type::in_bounds ( i_... ) );
+        return data ( )[ mapping_type::offset ( i_... ) ];
+    }
+    template<typename... Indices>
+    requires( sizeof...( Indices ) == Extents::rank ( ) and ( std::is_integral<Indices>::value and ... ) ) //
+        [[nodiscard]] constexpr reference operator( ) ( Indices const... i_ ) noexcept {
+        assert ( mapping_type::in_bounds ( i_... ) );
+        return data ( )[ mapping_type::offset ( i_... ) ];
+    }
+
+    template<typename... Indices>
+    requires( sizeof...( Indices ) == Extents::rank ( ) and ( std::is_integral<Indices>::value and ... ) ) //
+        [[nodiscard]] const_reference at ( Indices const... i_ ) const {
+        if ( mapping_type::in_bounds ( i_... ) )
+            return data ( )[ mapping_type::offset ( i_... ) ];
+        else
+            throw std::runtime_error ( "md_based_array: index out of bounds" );
+    }
+    template<typename... Indices>
+    requires( sizeof...( Indices ) == Extents::rank ( ) and ( std::is_integral<Indices>::value and ... ) ) //
+        [[nodiscard]] reference at ( Indices const... i_ ) {
+        return const_cast<reference> ( std::as_const ( *this ).at ( i_... ) );
+    }
+
+    // Views.
+
+    [[nodiscard]] constexpr view_type view ( ) noexcept { return view_type ( data ( ) ); }
+    [[nodiscard]] constexpr const_view_type view ( ) const noexcept { return const_view_type ( data ( ) ); }
+
+    // Sizes and strides.
+
+    [[nodiscard]] static constexpr size_type rank ( ) noexcept { return Extents::rank ( ); }
+    [[nodiscard]] static constexpr index_type extent ( size_type r_ ) noexcept { return Extents::values[ r_ ]; }
+    [[nodiscard]] static constexpr index_type base ( size_type r_ ) noexcept { return Bases::values[ r_ ]; }
+    [[nodiscard]] static constexpr index_type stride ( size_type r_ ) noexcept { return mapping_type::strides[ r_ ]; }
+    [[nodiscard]] static constexpr size_type size ( ) noexcept { return Extents::size ( ); }
+
+    // STL-functionality.
+
+    void fill ( value_type const & value_ ) { m_data.fill ( value_ ); }
+
+    // Output.
+
+    template<typename Stream>
+    [[maybe_unused]] friend Stream & operator<< ( Stream & out_, md_based_array const & m_ ) noexcept {
+        return out_ << m_.m_data;
+    }
+
+    data_type m_data;
+};
+
+} // namespace sax
@@ -32,10 +32,25 @@
 #include <sax/iostream.hpp>
 #include <initializer_list>
 #include <limits>
+#include <memory>
+#include <span>
+#include <stdexcept>
 #include <type_traits>
+#include <utility>
+
+#if defined( _MSC_VER ) and not defined( __clang__ )
+#    include <intrin.h>
+#endif
+
+#if defined( __SSE2__ ) or defined( _M_X64 ) or ( defined( _M_IX86_FP ) and _M_IX86_FP == 2 )
+#    define SAX_HAS_SSE2 1
+#    include <immintrin.h>
+#endif
 
 #include <sax/stl.hpp>
 
+#include "based_io.hpp"
+
 namespace sax {
 
 struct compare_3way {
@@ -58,8 +73,211 @@ template<typename InputIt1, typename InputIt2, typename Compare = compare_3way>
     return first1_ == last1_ ? ( ( int ) ( first2_ == last2_ ) - 1 ) : 1;
 }
 
-template<typename ValueType, std::size_t Size, std::size_t SSEThreshold = 48ull>
-struct alignas ( ( sizeof ( ValueType ) * Size ) >= SSEThreshold ? std::max ( alignof ( ValueType ), 16ull )
+// Bounds checking of the element access functions ( operator[], get, front and back ), at ( ) always throws.
+//
+// unchecked: no checking at all.
+// assertion: assert, i.e. checked in debug builds only (the default).
+// trap:      one predictable branch to a trap instruction, cheap hardening for release builds.
+// exception: throws std::runtime_error, like at ( ).
+
+enum class access_mode : int { unchecked, assertion, trap, exception };
+
+#if not defined( SAX_BASED_ARRAY_ACCESS_MODE )
+#    define SAX_BASED_ARRAY_ACCESS_MODE sax::access_mode::assertion
+#endif
+
+namespace detail {
+[[noreturn]] inline void trap ( ) noexcept {
+#if defined( __GNUC__ ) or defined( __clang__ )
+    __builtin_trap ( );
+#else
+    __debugbreak ( );
+    std::abort ( );
+#endif
+}
+
+// Element-wise conversion kernels, used by the converting constructors and assignments of based_array. The pairs
+// below are vectorized (AVX2 if available, SSE2 otherwise), all other pairs convert with static_cast, one element at
+// a time. Note that the int64 -> int32 narrowing saturates, instead of wrapping around.
+
+template<typename T, std::size_t S>
+inline constexpr bool is_signed_integer_v = std::is_integral<T>::value and std::is_signed<T>::value and sizeof ( T ) == S;
+template<typename T, std::size_t S>
+inline constexpr bool is_unsigned_integer_v =
+    std::is_integral<T>::value and std::is_unsigned<T>::value and not std::is_same<T, bool>::value and sizeof ( T ) == S;
+
+template<typename To, typename From>
+void convert_scalar ( To * to_, From const * from_, std::size_t n_ ) noexcept {
+    for ( std::size_t i = 0ull; i < n_; ++i )
+        to_[ i ] = static_cast<To> ( from_[ i ] );
+}
+
+inline void convert_i32_f32 ( float * to_, std::int32_t const * from_, std::size_t n_ ) noexcept {
+    std::size_t i = 0ull;
+#if defined( __AVX2__ )
+    for ( ; i + 8ull <= n_; i += 8ull )
+        _mm256_storeu_ps ( to_ + i, _mm256_cvtepi32_ps ( _mm256_loadu_si256 ( reinterpret_cast<__m256i const *> ( from_ + i ) ) ) );
+#endif
+#if defined( SAX_HAS_SSE2 )
+    for ( ; i + 4ull <= n_; i += 4ull )
+        _mm_storeu_ps ( to_ + i, _mm_cvtepi32_ps ( _mm_loadu_si128 ( reinterpret_cast<__m128i const *> ( from_ + i ) ) ) );
+#endif
+    convert_scalar ( to_ + i, from_ + i, n_ - i );
+}
+
+inline void convert_f32_i32 ( std::int32_t * to_, float const * from_, std::size_t n_ ) noexcept {
+    std::size_t i = 0ull;
+#if defined( __AVX2__ )
+    for ( ; i + 8ull <= n_; i += 8ull )
+        _mm256_storeu_si256 ( reinterpret_cast<__m256i *> ( to_ + i ), _mm256_cvttps_epi32 ( _mm256_loadu_ps ( from_ + i ) ) );
+#endif
+#if defined( SAX_HAS_SSE2 )
+    for ( ; i + 4ull <= n_; i += 4ull )
+        _mm_storeu_si128 ( reinterpret_cast<__m128i *> ( to_ + i ), _mm_cvttps_epi32 ( _mm_loadu_ps ( from_ + i ) ) );
+#endif
+    convert_scalar ( to_ + i, from_ + i, n_ - i );
+}
+
+inline void convert_f32_f64 ( double * to_, float const * from_, std::size_t n_ ) noexcept {
+    std::size_t i = 0ull;
+#if defined( __AVX2__ )
+    for ( ; i + 4ull <= n_; i += 4ull )
+        _mm256_storeu_pd ( to_ + i, _mm256_cvtps_pd ( _mm_loadu_ps ( from_ + i ) ) );
+#endif
+#if defined( SAX_HAS_SSE2 )
+    for ( ; i + 4ull <= n_; i += 4ull ) {
+        __m128 const f = _mm_loadu_ps ( from_ + i );
+        _mm_storeu_pd ( to_ + i, _mm_cvtps_pd ( f ) );
+        _mm_storeu_pd ( to_ + i + 2ull, _mm_cvtps_pd ( _mm_movehl_ps ( f, f ) ) );
+    }
+#endif
+    convert_scalar ( to_ + i, from_ + i, n_ - i );
+}
+
+inline void convert_f64_f32 ( float * to_, double const * from_, std::size_t n_ ) noexcept {
+    std::size_t i = 0ull;
+#if defined( __AVX2__ )
+    for ( ; i + 4ull <= n_; i += 4ull )
+        _mm_storeu_ps ( to_ + i, _mm256_cvtpd_ps ( _mm256_loadu_pd ( from_ + i ) ) );
+#endif
+#if defined( SAX_HAS_SSE2 )
+    for ( ; i + 4ull <= n_; i += 4ull )
+        _mm_storeu_ps ( to_ + i,
+                        _mm_movelh_ps ( _mm_cvtpd_ps ( _mm_loadu_pd ( from_ + i ) ), _mm_cvtpd_ps ( _mm_loadu_pd ( from_ + i + 2ull ) ) ) );
+#endif
+    convert_scalar ( to_ + i, from_ + i, n_ - i );
+}
+
+inline void convert_u8_i32 ( std::int32_t * to_, std::uint8_t const * from_, std::size_t n_ ) noexcept {
+    std::size_t i = 0ull;
+#if defined( __AVX2__ )
+    for ( ; i + 8ull <= n_; i += 8ull )
+        _mm256_storeu_si256 ( reinterpret_cast<__m256i *> ( to_ + i ),
+                              _mm256_cvtepu8_epi32 ( _mm_loadl_epi64 ( reinterpret_cast<__m128i const *> ( from_ + i ) ) ) );
+#endif
+#if defined( SAX_HAS_SSE2 )
+    __m128i const zero = _mm_setzero_si128 ( );
+    for ( ; i + 16ull <= n_; i += 16ull ) {
+        __m128i const b  = _mm_loadu_si128 ( reinterpret_cast<__m128i const *> ( from_ + i ) );
+        __m128i const lo = _mm_unpacklo_epi8 ( b, zero ), hi = _mm_unpackhi_epi8 ( b, zero );
+        __m128i * to     = reinterpret_cast<__m128i *> ( to_ + i );
+        _mm_storeu_si128 ( to + 0, _mm_unpacklo_epi16 ( lo, zero ) );
+        _mm_storeu_si128 ( to + 1, _mm_unpackhi_epi16 ( lo, zero ) );
+        _mm_storeu_si128 ( to + 2, _mm_unpacklo_epi16 ( hi, zero ) );
+        _mm_storeu_si128 ( to + 3, _mm_unpackhi_epi16 ( hi, zero ) );
+    }
+#endif
+    convert_scalar ( to_ + i, from_ + i, n_ - i );
+}
+
+inline void convert_i64_i32_saturate ( std::int32_t * to_, std::int64_t const * from_, std::size_t n_ ) noexcept {
+    constexpr std::int64_t lo = std::numeric_limits<std::int32_t>::min ( ), hi = std::numeric_limits<std::int32_t>::max ( );
+    std::size_t i = 0ull;
+#if defined( __AVX2__ )
+    __m256i const min = _mm256_set1_epi64x ( lo ), max = _mm256_set1_epi64x ( hi );
+    __m256i const even = _mm256_setr_epi32 ( 0, 2, 4, 6, 0, 2, 4, 6 ); // The low halves of the 64-bit lanes.
+    for ( ; i + 4ull <= n_; i += 4ull ) {
+        __m256i v = _mm256_loadu_si256 ( reinterpret_cast<__m256i const *> ( from_ + i ) );
+        v         = _mm256_blendv_epi8 ( v, max, _mm256_cmpgt_epi64 ( v, max ) );
+        v         = _mm256_blendv_epi8 ( v, min, _mm256_cmpgt_epi64 ( min, v ) );
+        _mm_storeu_si128 ( reinterpret_cast<__m128i *> ( to_ + i ),
+                           _mm256_castsi256_si128 ( _mm256_permutevar8x32_epi32 ( v, even ) ) );
+    }
+#endif
+    for ( ; i < n_; ++i ) // SSE2 lacks 64-bit compares, the compiler vectorizes this where it can.
+        to_[ i ] = static_cast<std::int32_t> ( from_[ i ] < lo ? lo : from_[ i ] > hi ? hi : from_[ i ] );
+}
+
+template<typename To, typename From>
+void convert ( To * to_, From const * from_, std::size_t n_ ) noexcept {
+    if constexpr ( is_signed_integer_v<From, 4ull> and std::is_same<To, float>::value )
+        convert_i32_f32 ( to_, reinterpret_cast<std::int32_t const *> ( from_ ), n_ );
+    else if constexpr ( std::is_same<From, float>::value and is_signed_integer_v<To, 4ull> )
+        convert_f32_i32 ( reinterpret_cast<std::int32_t *> ( to_ ), from_, n_ );
+    else if constexpr ( std::is_same<From, float>::value and std::is_same<To, double>::value )
+        convert_f32_f64 ( to_, from_, n_ );
+    else if constexpr ( std::is_same<From, double>::value and std::is_same<To, float>::value )
+        convert_f64_f32 ( to_, from_, n_ );
+    else if constexpr ( is_unsigned_integer_v<From, 1ull> and is_signed_integer_v<To, 4ull> )
+        convert_u8_i32 ( reinterpret_cast<std::int32_t *> ( to_ ), reinterpret_cast<std::uint8_t const *> ( from_ ), n_ );
+    else if constexpr ( is_signed_integer_v<From, 8ull> and is_signed_integer_v<To, 4ull> )
+        convert_i64_i32_saturate ( reinterpret_cast<std::int32_t *> ( to_ ), reinterpret_cast<std::int64_t const *> ( from_ ),
+                                   n_ );
+    else
+        convert_scalar ( to_, from_, n_ );
+}
+
+} // namespace detail
+
+// Tag (base) of the lazily evaluated expressions of based_expression.hpp.
+
+struct based_expression_base {};
+
+namespace detail {
+// The alignment (a power of 2) that remains of Alignment at a byte offset of Offset.
+[[nodiscard]] constexpr std::size_t offset_alignment ( std::size_t alignment_, std::size_t offset_ ) noexcept {
+    std::size_t const low = offset_ & ( ~offset_ + 1ull ); // Lowest set bit, 0 for offset 0.
+    return low and low < alignment_ ? low : alignment_;
+}
+} // namespace detail
+
+// A view of Count elements, a std::span<ValueType, Count> (and converts to one), that carries its alignment in the
+// type, data ( ) and operator[] pass that on to the compiler with std::assume_aligned, so that (SIMD) kernels over it
+// use aligned loads and stores. Returned by based_array::subarray, no copy.
+
+template<typename ValueType, std::size_t Count, std::size_t Alignment>
+struct aligned_span : std::span<ValueType, Count> {
+    using span_type = std::span<ValueType, Count>;
+
+    static_assert ( Alignment and not( Alignment & ( Alignment - 1ull ) ), "aligned_span: Alignment should be a power of 2" );
+    static_assert ( Alignment >= alignof ( ValueType ), "aligned_span: Alignment should not be less than alignof ( ValueType )" );
+
+    static constexpr std::size_t alignment = Alignment;
+
+    constexpr explicit aligned_span ( ValueType * data_ ) noexcept : span_type{ data_, Count } {
+        assert ( not( reinterpret_cast<std::uintptr_t> ( data_ ) & ( Alignment - 1ull ) ) );
+    }
+
+    [[nodiscard]] constexpr ValueType * data ( ) const noexcept {
+        return std::assume_aligned<Alignment> ( span_type::data ( ) );
+    }
+    [[nodiscard]] constexpr ValueType & operator[] ( std::size_t i_ ) const noexcept {
+        assert ( i_ < Count );
+        return data ( )[ i_ ];
+    }
+    [[nodiscard]] constexpr span_type span ( ) const noexcept { return *this; }
+
+    // A sub-view, [ Offset, Offset + Sub ), with the alignment that remains.
+    template<std::size_t Offset, std::size_t Sub>
+    [[nodiscard]] constexpr auto subarray ( ) const noexcept {
+        static_assert ( Offset + Sub <= Count, "aligned_span: subarray out of bounds" );
+        return aligned_span<ValueType, Sub, detail::offset_alignment ( Alignment, Offset * sizeof ( ValueType ) )>{ data ( ) + Offset };
+    }
+};
+
+template<typename ValueType, std::size_t Size, std::size_t SSEThreshold = 48ull,
+         access_mode Access = SAX_BASED_ARRAY_ACCESS_MODE>
+struct alignas ( ( sizeof ( ValueType ) * Size ) >= SSEThreshold ? std::max<std::size_t> ( alignof ( ValueType ), 16ull )
                                                                  : alignof ( ValueType ) ) based_array {
     private:
     using data_type      = std::array<ValueType, Size>;
@@ -78,11 +296,14 @@ struct alignas ( ( sizeof ( ValueType ) * Size ) >= SSEThreshold ? std::max ( al
     using reverse_iterator       = typename data_type::reverse_iterator;
     using const_reverse_iterator = typename data_type::const_reverse_iterator;
 
+    // The copies (memcpy or std::copy) throw only if the element assignment does.
+    static constexpr bool nothrow_copy = std::is_nothrow_copy_assignable<value_type>::value;
+
     explicit based_array ( ) noexcept = default;
 
     // based_array's.
 
-    based_array ( based_array const & other_ ) { copy ( other_ ); }
+    based_array ( based_array const & other_ ) noexcept ( nothrow_copy ) { copy ( other_ ); }
     based_array ( based_array && other_ ) noexcept { move ( std::move ( other_ ) ); }
 
     // Convertible types.
@@ -118,9 +339,17 @@ struct alignas ( ( sizeof ( ValueType ) * Size ) >= SSEThreshold ? std::max ( al
         std::copy ( std::cbegin ( list_ ), std::cend ( list_ ), begin ( ) );
     }
 
+    // Expressions (see based_expression.hpp), evaluated in one loop, without temporaries.
+
+    template<typename Expression>
+    requires( std::is_base_of<based_expression_base, Expression>::value ) //
+        based_array ( Expression const & expression_ ) noexcept {
+        evaluate ( expression_ );
+    }
+
     // Assignment.
 
-    [[maybe_unused]] based_array & operator= ( based_array const & rhs_ ) {
+    [[maybe_unused]] based_array & operator= ( based_array const & rhs_ ) noexcept ( nothrow_copy ) {
         if ( std::addressof ( rhs_ ) != this )
             copy ( rhs_ );
         return *this;
@@ -135,27 +364,23 @@ struct alignas ( ( sizeof ( ValueType ) * Size ) >= SSEThreshold ? std::max ( al
 
     template<typename U>
     [[maybe_unused]] based_array & operator= ( based_array<U, Size> const & rhs_ ) {
-        if ( std::addressof ( rhs_ ) != this )
-            copy ( rhs_ );
+        copy ( rhs_ );
         return *this;
     }
     template<typename U>
     [[maybe_unused]] based_array & operator= ( based_array<U, Size> && rhs_ ) noexcept {
-        if ( std::addressof ( rhs_ ) != this )
-            move ( std::move ( rhs_ ) );
+        move ( std::move ( rhs_ ) );
         return *this;
     }
 
     // Assign from std::array.
 
     [[maybe_unused]] based_array & operator= ( std_array_type const & rhs_ ) {
-        if ( std::addressof ( rhs_ ) != this )
-            copy ( rhs_ );
+        copy ( rhs_ );
         return *this;
     }
     [[maybe_unused]] based_array & operator= ( std_array_type && rhs_ ) noexcept {
-        if ( std::addressof ( rhs_ ) != this )
-            move ( std::move ( rhs_ ) );
+        move ( std::move ( rhs_ ) );
         return *this;
     }
 
@@ -163,14 +388,12 @@ struct alignas ( ( sizeof ( ValueType ) * Size ) >= SSEThreshold ? std::max ( al
 
     template<typename U>
     [[maybe_unused]] based_array & operator= ( std::array<U, Size> const & rhs_ ) {
-        if ( std::addressof ( rhs_ ) != this )
-            copy ( rhs_ );
+        copy ( rhs_ );
         return *this;
     }
     template<typename U>
     [[maybe_unused]] based_array & operator= ( std::array<U, Size> && rhs_ ) noexcept {
-        if ( std::addressof ( rhs_ ) != this )
-            move ( std::move ( rhs_ ) );
+        move ( std::move ( rhs_ ) );
         return *this;
     }
 
@@ -181,6 +404,15 @@ struct alignas ( ( sizeof ( ValueType ) * Size ) >= SSEThreshold ? std::max ( al
         return *this;
     }
 
+    // Expressions.
+
+    template<typename Expression>
+    requires( std::is_base_of<based_expression_base, Expression>::value ) //
+        [[maybe_unused]] based_array & operator= ( Expression const & expression_ ) noexcept {
+        evaluate ( expression_ );
+        return *this;
+    }
+
     // data ( ), allows interaction with STL.
 
     [[nodiscard]] constexpr const_pointer data ( ) const noexcept { return m_data.data ( ); }
@@ -198,6 +430,37 @@ struct alignas ( ( sizeof ( ValueType ) * Size ) >= SSEThreshold ? std::max ( al
         return data ( ) - Base;
     }
 
+    // Sub-arrays, views of Count elements from Offset on, zero- resp. one-based, no copy. The view is an aligned_span,
+    // it has the alignment of the based_array as far as Offset * sizeof ( value_type ) preserves it, f.e. in a 16-byte
+    // aligned based_array<float, 16>, subarray<4, 8> ( ) is 16-byte aligned, subarray<2, 8> ( ) 8-byte aligned.
+
+    public:
+    template<size_type Offset, size_type Count>
+    [[nodiscard]] constexpr auto subarray ( ) noexcept {
+        return subarray_base<0, Offset, Count, value_type> ( data ( ) );
+    }
+    template<size_type Offset, size_type Count>
+    [[nodiscard]] constexpr auto subarray ( ) const noexcept {
+        return subarray_base<0, Offset, Count, value_type const> ( data ( ) );
+    }
+    template<size_type Offset, size_type Count>
+    [[nodiscard]] constexpr auto subarray_b1 ( ) noexcept {
+        return subarray_base<1, Offset, Count, value_type> ( data ( ) );
+    }
+    template<size_type Offset, size_type Count>
+    [[nodiscard]] constexpr auto subarray_b1 ( ) const noexcept {
+        return subarray_base<1, Offset, Count, value_type const> ( data ( ) );
+    }
+
+    private:
+    template<size_type Base, size_type Offset, size_type Count, typename Type>
+    [[nodiscard]] static constexpr auto subarray_base ( Type * data_ ) noexcept {
+        static_assert ( Base <= Offset and Offset - Base + Count <= Size, "based_array: subarray out of bounds" );
+        constexpr size_type offset    = Offset - Base;
+        constexpr size_type alignment = detail::offset_alignment ( alignof ( based_array ), offset * sizeof ( value_type ) );
+        return aligned_span<Type, Count, alignment>{ data_ + offset };
+    }
+
     // Iterators.
 
     public:
@@ -215,39 +478,99 @@ struct alignas ( ( sizeof ( ValueType ) * Size ) >= SSEThreshold ? std::max ( al
 
     // Access.
 
-    [[nodiscard]] reference front ( ) noexcept { return m_data.front ( ); }
-    [[nodiscard]] const_reference front ( ) const noexcept { return m_data.front ( ); }
+    [[nodiscard]] constexpr reference front ( ) noexcept ( nothrow_access ) {
+        check_bounds<0> ( 0ull );
+        return m_data.front ( );
+    }
+    [[nodiscard]] constexpr const_reference front ( ) const noexcept ( nothrow_access ) {
+        check_bounds<0> ( 0ull );
+        return m_data.front ( );
+    }
 
-    [[nodiscard]] reference back ( ) noexcept { return m_data.back ( ); }
-    [[nodiscard]] const_reference back ( ) const noexcept { return m_data.back ( ); }
+    [[nodiscard]] constexpr reference back ( ) noexcept ( nothrow_access ) {
+        check_bounds<0> ( Size - 1ull );
+        return m_data.back ( );
+    }
+    [[nodiscard]] constexpr const_reference back ( ) const noexcept ( nothrow_access ) {
+        check_bounds<0> ( Size - 1ull );
+        return m_data.back ( );
+    }
 
     template<difference_type Base>
     [[nodiscard]] const_reference at ( size_type const i_ ) const {
-        if ( Base < i_ and i_ <= Base + size ( ) )
-            return get<Base> ( i_ );
+        if ( in_bounds<Base> ( i_ ) )
+            return data_base<Base> ( )[ i_ ];
         else
             throw std::runtime_error ( "based_array: index out of bounds" );
     }
     template<difference_type Base>
     [[nodiscard]] reference at ( size_type const i_ ) {
-        return const_cast<reference> ( std::as_const ( *this ).at<Base> ( i_ ) );
+        return const_cast<reference> ( std::as_const ( *this ).template at<Base> ( i_ ) );
     }
 
     // Subscript operator, only in base = 0.
-    [[nodiscard]] constexpr const_reference operator[] ( size_type const i_ ) const noexcept { return m_data[ i_ ]; }
-    [[nodiscard]] constexpr reference operator[] ( size_type const i_ ) noexcept { return m_data[ i_ ]; }
+    [[nodiscard]] constexpr const_reference operator[] ( size_type const i_ ) const noexcept ( nothrow_access ) {
+        check_bounds<0> ( i_ );
+        return m_data[ i_ ];
+    }
+    [[nodiscard]] constexpr reference operator[] ( size_type const i_ ) noexcept ( nothrow_access ) {
+        check_bounds<0> ( i_ );
+        return m_data[ i_ ];
+    }
 
     template<difference_type Base>
-    [[nodiscard]] constexpr const_reference get ( size_type const i_ ) const noexcept {
-        assert ( Base < i_ and i_ <= Base + size ( ) );
+    [[nodiscard]] constexpr const_reference get ( size_type const i_ ) const noexcept ( nothrow_access ) {
+        check_bounds<Base> ( i_ );
         return data_base<Base> ( )[ i_ ];
     }
     template<difference_type Base>
-    [[nodiscard]] constexpr reference get ( size_type const i_ ) noexcept {
-        assert ( Base < i_ and i_ <= Base + size ( ) );
+    [[nodiscard]] constexpr reference get ( size_type const i_ ) noexcept ( nothrow_access ) {
+        check_bounds<Base> ( i_ );
         return data_base<Base> ( )[ i_ ];
     }
 
+    // Compile-time index, checked at compile time, f.e. get<1, 1> ( ) is the first element.
+
+    template<difference_type Base, difference_type I>
+    [[nodiscard]] constexpr const_reference get ( ) const noexcept {
+        static_assert ( Base <= I and I < Base + static_cast<difference_type> ( Size ), "based_array: index out of bounds" );
+        return m_data[ static_cast<size_type> ( I - Base ) ];
+    }
+    template<difference_type Base, difference_type I>
+    [[nodiscard]] constexpr reference get ( ) noexcept {
+        static_assert ( Base <= I and I < Base + static_cast<difference_type> ( Size ), "based_array: index out of bounds" );
+        return m_data[ static_cast<size_type> ( I - Base ) ];
+    }
+
+    // Bounds checking.
+
+    static constexpr access_mode access  = Access;
+    static constexpr bool nothrow_access = Access != access_mode::exception;
+
+    private:
+    // Valid indices are [ Base, Base + Size ), one (unsigned) comparison.
+    template<difference_type Base>
+    [[nodiscard]] static constexpr bool in_bounds ( size_type const i_ ) noexcept {
+        return static_cast<size_type> ( static_cast<difference_type> ( i_ ) - Base ) < Size;
+    }
+
+    template<difference_type Base>
+    static constexpr void check_bounds ( [[maybe_unused]] size_type const i_ ) noexcept ( nothrow_access ) {
+        if constexpr ( Access == access_mode::assertion ) {
+            assert ( in_bounds<Base> ( i_ ) );
+        }
+        else if constexpr ( Access == access_mode::trap ) {
+            if ( not in_bounds<Base> ( i_ ) ) [[unlikely]]
+                detail::trap ( );
+        }
+        else if constexpr ( Access == access_mode::exception ) {
+            if ( not in_bounds<Base> ( i_ ) ) [[unlikely]]
+                throw std::runtime_error ( "based_array: index out of bounds" );
+        }
+    }
+
+    public:
+
     // Sizes.
 
     [[nodiscard]] static constexpr size_type capacity ( ) noexcept { return Size; }
@@ -259,6 +582,35 @@ struct alignas ( ( sizeof ( ValueType ) * Size ) >= SSEThreshold ? std::max ( al
     void fill ( value_type const & value_ ) { m_data.fill ( value_ ); }
     void swap ( based_array & other_ ) noexcept { m_data.swap ( other_ ); }
 
+    // Binary I/O (see based_io.hpp), to/from a file descriptor, or a buffer, returning the number of bytes written/read,
+    // 0 on failure. On a failed read the contents are unspecified.
+
+    [[nodiscard]] std::size_t write_to ( int fd_ ) const noexcept {
+        return detail::write_binary ( fd_, io_kind::based_array, data ( ), Size ) ? sizeof ( io_header ) + Size * sizeof ( value_type )
+                                                                                  : 0ull;
+    }
+    [[nodiscard]] std::size_t write_to ( std::span<std::byte> buffer_ ) const noexcept {
+        return detail::write_binary ( buffer_, io_kind::based_array, data ( ), Size );
+    }
+
+    [[nodiscard]] std::size_t read_from ( int fd_ ) noexcept {
+        return detail::read_binary ( fd_, io_kind::based_array, data ( ), Size ) ? sizeof ( io_header ) + Size * sizeof ( value_type )
+                                                                                 : 0ull;
+    }
+    [[nodiscard]] std::size_t read_from ( std::span<std::byte const> buffer_ ) noexcept {
+        if ( detail::read_header<value_type> ( buffer_, io_kind::based_array ) != static_cast<std::int64_t> ( Size ) )
+            return 0ull;
+        std::memcpy ( data ( ), buffer_.data ( ) + sizeof ( io_header ), Size * sizeof ( value_type ) );
+        return sizeof ( io_header ) + Size * sizeof ( value_type );
+    }
+
+    // Text output, std::to_chars based, for arithmetic types much faster than operator<<.
+
+    template<typename Stream>
+    [[maybe_unused]] Stream & write_text ( Stream & out_ ) const {
+        return detail::write_text ( out_, data ( ), Size );
+    }
+
     private:
     void memcpy_impl ( std::byte * to_, std::byte const * from_ ) noexcept {
         constexpr size_type const zero = 0ull;
@@ -288,7 +640,7 @@ struct alignas ( ( sizeof ( ValueType ) * Size ) >= SSEThreshold ? std::max ( al
         return reinterpret_cast<std::byte const *> ( std::addressof ( *it_ ) );
     }
 
-    void copy_impl ( const_iterator begin_, const_iterator end_ ) {
+    void copy_impl ( const_iterator begin_, const_iterator end_ ) noexcept ( nothrow_copy ) {
         if constexpr ( std::is_trivially_copyable<value_type>::value and sizeof ( based_array ) >= SSEThreshold )
             memcpy_impl ( reinterpret_cast<std::byte *> ( m_data.data ( ) ), byte_addressof ( begin_ ) );
         else
@@ -302,25 +654,51 @@ struct alignas ( ( sizeof ( ValueType ) * Size ) >= SSEThreshold ? std::max ( al
             std::move ( begin_, end_, m_data.begin ( ) );
     }
 
+    template<typename Expression>
+    void evaluate ( Expression const & expression_ ) noexcept {
+        static_assert ( Expression::size ( ) == Size, "based_array: the expression is of a different size" );
+        pointer d = m_data.data ( );
+        for ( size_type i = 0ull; i < Size; ++i )
+            d[ i ] = static_cast<value_type> ( expression_[ i ] );
+    }
+
+    // Differing element types, the memcpy-path does not apply, convert (vectorized for common pairs) instead.
+    template<typename U>
+    void convert_impl ( U const * from_ ) noexcept {
+        detail::convert ( m_data.data ( ), from_, Size );
+    }
+
     public:
-    void copy ( based_array const & other_ ) { copy_impl ( other_.cbegin ( ), other_.cend ( ) ); }
+    void copy ( based_array const & other_ ) noexcept ( nothrow_copy ) { copy_impl ( other_.cbegin ( ), other_.cend ( ) ); }
     template<typename U>
     void copy ( based_array<U, Size> const & other_ ) {
-        copy_impl ( other_.cbegin ( ), other_.cend ( ) );
+        if constexpr ( std::is_same<U, value_type>::value )
+            copy_impl ( other_.cbegin ( ), other_.cend ( ) );
+        else
+            convert_impl ( other_.data ( ) );
     }
     template<typename U>
     void copy ( std::array<U, Size> const & other_ ) {
-        copy_impl ( other_.cbegin ( ), other_.cend ( ) );
+        if constexpr ( std::is_same<U, value_type>::value )
+            copy_impl ( other_.cbegin ( ), other_.cend ( ) );
+        else
+            convert_impl ( other_.data ( ) );
     }
 
     void move ( based_array && other_ ) noexcept { move_impl ( other_.cbegin ( ), other_.cend ( ) ); }
     template<typename U>
     void move ( based_array<U, Size> && other_ ) noexcept {
-        move_impl ( other_.cbegin ( ), other_.cend ( ) );
+        if constexpr ( std::is_same<U, value_type>::value )
+            move_impl ( other_.cbegin ( ), other_.cend ( ) );
+        else
+            convert_impl ( other_.data ( ) );
     }
     template<typename U>
     void move ( std::array<U, Size> && other_ ) noexcept {
-        move_impl ( other_.cbegin ( ), other_.cend ( ) );
+        if constexpr ( std::is_same<U, value_type>::value )
+            move_impl ( other_.cbegin ( ), other_.cend ( ) );
+        else
+            convert_impl ( other_.data ( ) );
     }
 
     // Global functions.
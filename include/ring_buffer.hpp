@@ -0,0 +1,209 @@
+
+// MIT License
+//
+// Copyright (c) 2020 degski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, rhs_, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <algorithm>
+#include <atomic>
+#include <type_traits>
+#include <utility>
+
+#include "one_based_array.hpp"
+
+// A bounded queue of Capacity (a power of 2) elements in based_array storage, for one consumer and one (wait-free) or
+// more (lock-free) producers, f.e.:
+//
+//     sax::ring_buffer<sax::based_array<float, 16>, 1'024> q;                                 // SPSC.
+//     sax::ring_buffer<record, 1'024, sax::ring_producers::multiple> r;                         // MPSC.
+//
+//     if ( not q.try_push ( a ) ) ...                                   // Full.
+//     std::size_t n = q.push ( records, 64 );                           // Pushes as many as fit, up to 64.
+//     std::size_t m = q.pop ( out, 64 );                                // Pops as many as available, up to 64.
+//
+// The indices increase monotonically and are masked on access. Head (consumer) and tail (producers) live on cache
+// lines of their own, each side keeps a cached copy of the other side's index and only reloads it if that copy says
+// full, resp. empty. Batches are claimed and published with one atomic operation and copied as (at most) two
+// contiguous runs.
+//
+// With multiple producers, a producer claims its slots with a CAS on the tail and publishes them per slot, with a
+// sequence number, in the order in which it is done. The consumer takes a published prefix, i.e. a producer that is
+// suspended between its claim and its publication holds up the consumer (not the other producers). A claimed slot
+// has to be published, the assignment to it should therefore not throw.
+
+namespace sax {
+
+enum class ring_producers : int { single, multiple };
+
+namespace detail {
+inline constexpr std::size_t ring_line_size = 64ull;
+
+struct ring_no_sequence {};
+} // namespace detail
+
+template<typename ValueType, std::size_t Capacity, ring_producers Producers = ring_producers::single>
+struct ring_buffer {
+
+    static_assert ( Capacity and not( Capacity & ( Capacity - 1ull ) ), "ring_buffer: Capacity should be a power of 2" );
+
+    using value_type = ValueType;
+    using size_type  = std::size_t;
+
+    static constexpr ring_producers producers = Producers;
+
+    explicit ring_buffer ( ) noexcept = default;
+
+    ring_buffer ( ring_buffer const & ) = delete;
+    ring_buffer & operator= ( ring_buffer const & ) = delete;
+
+    // Producer(s).
+
+    template<typename U>
+    [[nodiscard]] bool try_push ( U && value_ ) noexcept ( std::is_nothrow_assignable<value_type &, U &&>::value ) {
+        static_assert ( Producers == ring_producers::single or std::is_nothrow_assignable<value_type &, U &&>::value,
+                        "ring_buffer: with multiple producers, the assignment should not throw" );
+        auto const [ pos, n ] = claim ( 1ull );
+        if ( not n )
+            return false;
+        m_data[ pos & mask ] = std::forward<U> ( value_ );
+        publish ( pos, 1ull );
+        return true;
+    }
+
+    // Pushes as many as fit, up to n_, from [ from_, from_ + n_ ), returns the number pushed.
+    [[nodiscard]] size_type push ( value_type const * from_, size_type n_ ) noexcept ( std::is_nothrow_copy_assignable<value_type>::value ) {
+        static_assert ( Producers == ring_producers::single or std::is_nothrow_copy_assignable<value_type>::value,
+                        "ring_buffer: with multiple producers, the assignment should not throw" );
+        auto const [ pos, n ] = claim ( n_ );
+        for_each_run ( pos, n, [ & ] ( size_type i_, size_type offset_, size_type run_ ) {
+            std::copy_n ( from_ + offset_, run_, m_data.data ( ) + i_ );
+        } );
+        publish ( pos, n );
+        return n;
+    }
+
+    // Consumer.
+
+    [[nodiscard]] bool try_pop ( value_type & value_ ) noexcept ( std::is_nothrow_move_assignable<value_type>::value ) {
+        auto const [ pos, n ] = acquire ( 1ull );
+        if ( not n )
+            return false;
+        value_ = std::move ( m_data[ pos & mask ] );
+        release ( pos, 1ull );
+        return true;
+    }
+
+    // Pops as many as available, up to n_, into [ to_, to_ + n_ ), returns the number popped.
+    [[nodiscard]] size_type pop ( value_type * to_, size_type n_ ) noexcept ( std::is_nothrow_move_assignable<value_type>::value ) {
+        auto const [ pos, n ] = acquire ( n_ );
+        for_each_run ( pos, n, [ & ] ( size_type i_, size_type offset_, size_type run_ ) {
+            std::move ( m_data.data ( ) + i_, m_data.data ( ) + i_ + run_, to_ + offset_ );
+        } );
+        release ( pos, n );
+        return n;
+    }
+
+    // Sizes, a snapshot, i.e. exact only if neither side is active. With multiple producers, size ( ) includes the
+    // claimed, but not yet published, elements.
+
+    [[nodiscard]] size_type size ( ) const noexcept {
+        size_type const head = m_head.load ( std::memory_order_acquire );
+        return m_tail.load ( std::memory_order_acquire ) - head;
+    }
+    [[nodiscard]] bool empty ( ) const noexcept { return not size ( ); }
+    [[nodiscard]] static constexpr size_type capacity ( ) noexcept { return Capacity; }
+
+    private:
+    static constexpr size_type mask = Capacity - 1ull;
+
+    // Claims up to n_ slots, returns the position of the first and the number claimed (0 if full).
+    [[nodiscard]] std::pair<size_type, size_type> claim ( size_type n_ ) noexcept {
+        size_type pos = m_tail.load ( std::memory_order_relaxed );
+        if constexpr ( Producers == ring_producers::single ) {
+            if ( Capacity - ( pos - m_head_cache ) < n_ )
+                m_head_cache = m_head.load ( std::memory_order_acquire );
+            return { pos, std::min ( n_, Capacity - ( pos - m_head_cache ) ) };
+        }
+        else {
+            size_type n;
+            do {
+                n = std::min ( n_, Capacity - ( pos - m_head.load ( std::memory_order_acquire ) ) );
+                if ( not n )
+                    break;
+            } while ( not m_tail.compare_exchange_weak ( pos, pos + n, std::memory_order_relaxed, std::memory_order_relaxed ) );
+            return { pos, n };
+        }
+    }
+
+    void publish ( size_type pos_, size_type n_ ) noexcept {
+        if constexpr ( Producers == ring_producers::single ) {
+            m_tail.store ( pos_ + n_, std::memory_order_release );
+        }
+        else {
+            for ( size_type p = pos_, e = pos_ + n_; p != e; ++p )
+                m_sequence[ p & mask ].store ( p + 1ull, std::memory_order_release );
+        }
+    }
+
+    // Acquires up to n_ published slots, returns the position of the first and the number acquired (0 if empty).
+    [[nodiscard]] std::pair<size_type, size_type> acquire ( size_type n_ ) noexcept {
+        size_type const pos = m_head.load ( std::memory_order_relaxed );
+        if constexpr ( Producers == ring_producers::single ) {
+            if ( m_tail_cache - pos < n_ )
+                m_tail_cache = m_tail.load ( std::memory_order_acquire );
+            return { pos, std::min ( n_, m_tail_cache - pos ) };
+        }
+        else {
+            size_type n = 0ull;
+            while ( n < n_ and m_sequence[ ( pos + n ) & mask ].load ( std::memory_order_acquire ) == pos + n + 1ull )
+                ++n;
+            return { pos, n };
+        }
+    }
+
+    void release ( size_type pos_, size_type n_ ) noexcept { m_head.store ( pos_ + n_, std::memory_order_release ); }
+
+    // Calls f_ ( index, offset, run ) for the (at most) two contiguous runs of [ pos_, pos_ + n_ ).
+    template<typename Function>
+    static void for_each_run ( size_type pos_, size_type n_, Function f_ ) {
+        size_type const i = pos_ & mask, first = std::min ( n_, Capacity - i );
+        if ( first )
+            f_ ( i, 0ull, first );
+        if ( n_ > first )
+            f_ ( 0ull, first, n_ - first );
+    }
+
+    using sequence_type = std::conditional_t<Producers == ring_producers::multiple,
+                                             based_array<std::atomic<size_type>, Capacity>, detail::ring_no_sequence>;
+
+    alignas ( detail::ring_line_size ) std::atomic<size_type> m_tail = 0ull; // Written by the producer(s).
+    size_type m_head_cache                                            = 0ull; // Producer-side, single producer only.
+    alignas ( detail::ring_line_size ) std::atomic<size_type> m_head = 0ull; // Written by the consumer.
+    size_type m_tail_cache                                            = 0ull; // Consumer-side, single producer only.
+    alignas ( detail::ring_line_size ) based_array<value_type, Capacity> m_data;
+    [[no_unique_address]] sequence_type m_sequence;
+};
+
+} // namespace sax